@@ -12,15 +12,54 @@ function (generate_cfs_startup_script CFS_INSTALL_DIR)
     )
 
     # the rest of the apps can vary by config
-    set(CFS_APP_STARTUP_ORDER lc cf ds fm hk hs mm sc md cs sbn)
-    foreach(APP ${CFS_APP_STARTUP_ORDER})
+    set(CFS_APP_STARTUP_LIST lc cf ds fm hk hs mm sc md cs sbn)
+
+    # Apps that must be started before a given app are declared as
+    # CFS_APP_DEPENDS_<app>.  A dependency only has an effect if that app is
+    # also being started on this target.
+    set(CFS_APP_DEPENDS_lc sc)   # LC action points request RTS execution from SC
+
+    set(CFS_APP_PENDING)
+    foreach(APP ${CFS_APP_STARTUP_LIST})
         list(FIND ARGN ${APP} SHOULD_START)
         if (SHOULD_START GREATER -1)
-            string(TOUPPER "${APP}" APP_UPPER)
-            file (APPEND ${STARTUP_FILE}
-                "CFE_APP, ${APP},  ${APP_UPPER}_AppMain, ${APP_UPPER}, 70,  131072, 0x0, 0;\n"
-            )
+            list(APPEND CFS_APP_PENDING ${APP})
+        endif()
+    endforeach()
+
+    # Emit the apps in list order, except that an app is held back until all of
+    # its dependencies have been emitted.  Each step emits the first pending app
+    # that is ready, so a held back app follows right after its last dependency.
+    set(CFS_APP_STARTUP_ORDER)
+    while(CFS_APP_PENDING)
+        set(CFS_APP_NEXT)
+        foreach(APP ${CFS_APP_PENDING})
+            set(DEPS_MET TRUE)
+            foreach(DEP ${CFS_APP_DEPENDS_${APP}})
+                list(FIND CFS_APP_PENDING ${DEP} DEP_PENDING)
+                if (DEP_PENDING GREATER -1)
+                    set(DEPS_MET FALSE)
+                endif()
+            endforeach()
+            if (DEPS_MET)
+                set(CFS_APP_NEXT ${APP})
+                break()
+            endif()
+        endforeach()
+
+        if (NOT CFS_APP_NEXT)
+            message(FATAL_ERROR "Circular startup dependency among apps: ${CFS_APP_PENDING}")
         endif()
+
+        list(APPEND CFS_APP_STARTUP_ORDER ${CFS_APP_NEXT})
+        list(REMOVE_ITEM CFS_APP_PENDING ${CFS_APP_NEXT})
+    endwhile()
+
+    foreach(APP ${CFS_APP_STARTUP_ORDER})
+        string(TOUPPER "${APP}" APP_UPPER)
+        file (APPEND ${STARTUP_FILE}
+            "CFE_APP, ${APP},  ${APP_UPPER}_AppMain, ${APP_UPPER}, 70,  131072, 0x0, 0;\n"
+        )
     endforeach()
 
 endfunction(generate_cfs_startup_script)
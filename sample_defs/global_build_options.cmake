@@ -26,6 +26,11 @@ else()
   set(MISSION_RESOURCEID_MODE "SIMPLE") # less type safe, but more backward compatible
 endif (OMIT_DEPRECATED)
 
+# Software Bus message map selection.  "DIRECT" is expected to already be the
+# SB routing module default; it is set explicitly here so the choice is visible
+# in the mission configuration and does not change silently with the default.
+set(MISSION_MSGMAP_IMPLEMENTATION "DIRECT")
+
 # Address Sanitizer option.  This enables the ASAN library that is available
 # in recent versions of GCC - although it may depend on additional packages being
 # installed, depending on development host OS/version.
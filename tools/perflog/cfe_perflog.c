@@ -0,0 +1,682 @@
+/************************************************************************
+ * NASA Docket No. GSC-18,719-1, and identified as “core Flight System: Bootes”
+ *
+ * Copyright (c) 2020 United States Government as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ************************************************************************/
+
+/**
+ * @file
+ *
+ * Host tool to reduce cFE ES performance log dump files
+ *
+ * The input is the file written by the ES "Stop Performance Analyzer"
+ * command: a cFE file header, the performance log metadata, and the
+ * captured markers in the order they were logged.
+ *
+ * For every performance ID this reports the entry-to-exit duration
+ * (min/max/mean and a log2-bucketed histogram) and the entry-to-entry
+ * period along with its jitter.
+ *
+ * The markers can also be exported in the Chrome trace event JSON format,
+ * which can be opened directly in Perfetto or chrome://tracing.  When several
+ * dump files are given, their markers are merged on the absolute timer value
+ * of each marker and every processor is shown as its own process, with one
+ * track per performance ID.  The merged timeline is only as well aligned as
+ * the timebases of the processors that produced the dumps.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+/*
+ * Layout of the dump file, see CFE_ES_RunPerfLogDump()
+ */
+#define PERFLOG_FS_HEADER_SIZE    64         /* sizeof(CFE_FS_Header_t) */
+#define PERFLOG_FS_CONTENT_ID     0x63464531 /* "cFE1" */
+#define PERFLOG_FS_SUBTYPE_PERF   4          /* CFE_FS_SubType_ES_PERFDATA */
+#define PERFLOG_META_FIXED_WORDS  12         /* CFE_ES_PerfMetaData_t, without the masks */
+#define PERFLOG_ENTRY_WORDS       3          /* CFE_ES_PerfDataEntry_t */
+#define PERFLOG_EXIT_BIT          0x80000000 /* CFE_MISSION_ES_PERF_EXIT_BIT */
+#define PERFLOG_HISTOGRAM_BUCKETS 32
+
+typedef struct
+{
+    uint32_t Version;
+    uint32_t Endian;
+    uint32_t TimerTicksPerSecond;
+    uint32_t TimerLow32Rollover;
+    uint32_t State;
+    uint32_t Mode;
+    uint32_t TriggerCount;
+    uint32_t DataStart;
+    uint32_t DataEnd;
+    uint32_t DataCount;
+    uint32_t InvalidMarkerReported;
+    uint32_t FilterTriggerMaskSize;
+} PerfLog_MetaData_t;
+
+typedef struct
+{
+    uint32_t Id;
+    int      IsExit;
+    uint64_t TimeNs; /* absolute timer value, in nanoseconds */
+} PerfLog_Marker_t;
+
+typedef struct
+{
+    uint32_t EntryCount;
+    uint32_t ExitCount;
+    uint32_t UnmatchedExits;
+    int      InProgress;
+    uint64_t LastEntryNs;
+
+    /* entry-to-exit duration */
+    uint32_t DurationCount;
+    double   DurationMin;
+    double   DurationMax;
+    double   DurationSum;
+    uint32_t Histogram[PERFLOG_HISTOGRAM_BUCKETS];
+
+    /* entry-to-entry period, running mean and variance (Welford) */
+    uint32_t PeriodCount;
+    double   PeriodMin;
+    double   PeriodMax;
+    double   PeriodMean;
+    double   PeriodM2;
+} PerfLog_IdStats_t;
+
+typedef struct
+{
+    const char        *FileName;
+    FILE              *fp;
+    int                SwapBytes;
+    PerfLog_MetaData_t Meta;
+    uint32_t           ProcessorId;
+    uint32_t           MaxIds;
+    uint32_t           EntriesRead;
+    uint32_t           InvalidIds;
+    PerfLog_IdStats_t *Stats;
+    int                HaveNext;
+    PerfLog_Marker_t   Next;
+} PerfLog_State_t;
+
+static uint32_t PerfLog_Swap32(uint32_t Val)
+{
+    return ((Val & 0x000000FF) << 24) | ((Val & 0x0000FF00) << 8) | ((Val & 0x00FF0000) >> 8)
+           | ((Val & 0xFF000000) >> 24);
+}
+
+static uint32_t PerfLog_BigEndian32(const uint8_t *Ptr)
+{
+    return ((uint32_t)Ptr[0] << 24) | ((uint32_t)Ptr[1] << 16) | ((uint32_t)Ptr[2] << 8) | (uint32_t)Ptr[3];
+}
+
+/*
+ * Reads words written in the byte order of the target that produced the file
+ */
+static int PerfLog_ReadWords(PerfLog_State_t *State, uint32_t *Words, size_t Count)
+{
+    size_t i;
+
+    if (fread(Words, sizeof(uint32_t), Count, State->fp) != Count)
+    {
+        return -1;
+    }
+
+    if (State->SwapBytes)
+    {
+        for (i = 0; i < Count; ++i)
+        {
+            Words[i] = PerfLog_Swap32(Words[i]);
+        }
+    }
+
+    return 0;
+}
+
+static int PerfLog_ReadHeaders(PerfLog_State_t *State)
+{
+    uint8_t  FsHeader[PERFLOG_FS_HEADER_SIZE];
+    uint32_t Words[PERFLOG_META_FIXED_WORDS];
+    uint32_t Val;
+
+    /* The cFE file header is always big endian */
+    if (fread(FsHeader, sizeof(FsHeader), 1, State->fp) != 1)
+    {
+        fprintf(stderr, "Error: file too short for cFE file header\n");
+        return -1;
+    }
+
+    Val = PerfLog_BigEndian32(&FsHeader[0]);
+    if (Val != PERFLOG_FS_CONTENT_ID)
+    {
+        fprintf(stderr, "Error: not a cFE file (content ID 0x%08lx)\n", (unsigned long)Val);
+        return -1;
+    }
+
+    Val = PerfLog_BigEndian32(&FsHeader[4]);
+    if (Val != PERFLOG_FS_SUBTYPE_PERF)
+    {
+        fprintf(stderr, "Warning: file subtype %lu is not a performance log\n", (unsigned long)Val);
+    }
+
+    State->ProcessorId = PerfLog_BigEndian32(&FsHeader[16]);
+
+    /*
+     * The metadata and entries are written in the target byte order.  The
+     * Version field is a small number, so it identifies which order was used.
+     */
+    State->SwapBytes = 0;
+    if (PerfLog_ReadWords(State, Words, PERFLOG_META_FIXED_WORDS) != 0)
+    {
+        fprintf(stderr, "Error: file too short for performance log metadata\n");
+        return -1;
+    }
+
+    if (Words[0] > 0xFFFF)
+    {
+        State->SwapBytes = 1;
+        for (Val = 0; Val < PERFLOG_META_FIXED_WORDS; ++Val)
+        {
+            Words[Val] = PerfLog_Swap32(Words[Val]);
+        }
+    }
+
+    memcpy(&State->Meta, Words, sizeof(State->Meta));
+
+    if (State->Meta.TimerTicksPerSecond == 0)
+    {
+        fprintf(stderr, "Error: TimerTicksPerSecond is zero\n");
+        return -1;
+    }
+
+    /* Skip over the filter and trigger masks, but use their size to bound the IDs */
+    State->MaxIds = State->Meta.FilterTriggerMaskSize * 32;
+    if (fseek(State->fp, 2 * sizeof(uint32_t) * (long)State->Meta.FilterTriggerMaskSize, SEEK_CUR) != 0)
+    {
+        fprintf(stderr, "Error: file too short for performance log masks\n");
+        return -1;
+    }
+
+    State->Stats = calloc(State->MaxIds, sizeof(PerfLog_IdStats_t));
+    if (State->Stats == NULL && State->MaxIds != 0)
+    {
+        fprintf(stderr, "Error: out of memory\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Returns 1 if a marker was read, 0 after all DataCount markers were read, -1 on error
+ */
+static int PerfLog_ReadMarker(PerfLog_State_t *State, PerfLog_Marker_t *Marker)
+{
+    uint32_t Entry[PERFLOG_ENTRY_WORDS];
+    uint64_t Ticks;
+
+    if (State->EntriesRead >= State->Meta.DataCount)
+    {
+        if (fgetc(State->fp) != EOF)
+        {
+            fprintf(stderr,
+                    "Warning: %s has extra data after the %lu logged entries\n",
+                    State->FileName,
+                    (unsigned long)State->Meta.DataCount);
+        }
+        return 0;
+    }
+
+    if (PerfLog_ReadWords(State, Entry, PERFLOG_ENTRY_WORDS) != 0)
+    {
+        fprintf(stderr,
+                "Error: %s truncated after %lu of %lu logged entries\n",
+                State->FileName,
+                (unsigned long)State->EntriesRead,
+                (unsigned long)State->Meta.DataCount);
+        return -1;
+    }
+
+    ++State->EntriesRead;
+
+    /* A rollover of zero means the lower word uses its full 32 bit range */
+    if (State->Meta.TimerLow32Rollover == 0)
+    {
+        Ticks = ((uint64_t)Entry[1] << 32) | Entry[2];
+    }
+    else
+    {
+        Ticks = ((uint64_t)Entry[1] * State->Meta.TimerLow32Rollover) + Entry[2];
+    }
+
+    Marker->Id     = Entry[0] & ~PERFLOG_EXIT_BIT;
+    Marker->IsExit = (Entry[0] & PERFLOG_EXIT_BIT) != 0;
+    Marker->TimeNs = (Ticks / State->Meta.TimerTicksPerSecond) * 1000000000
+                     + ((Ticks % State->Meta.TimerTicksPerSecond) * 1000000000) / State->Meta.TimerTicksPerSecond;
+
+    return 1;
+}
+
+/*
+ * Bucket N holds durations in [2^(N-1), 2^N) microseconds, bucket 0 is below 1 us
+ */
+static uint32_t PerfLog_HistogramBucket(double Duration)
+{
+    double   Usec   = Duration * 1000000.0;
+    uint32_t Bucket = 0;
+
+    while (Usec >= 1.0 && Bucket < (PERFLOG_HISTOGRAM_BUCKETS - 1))
+    {
+        Usec /= 2.0;
+        ++Bucket;
+    }
+
+    return Bucket;
+}
+
+static void PerfLog_Accumulate(PerfLog_State_t *State, const PerfLog_Marker_t *Marker)
+{
+    PerfLog_IdStats_t *Stats;
+    double             Period;
+    double             Delta;
+
+    if (Marker->Id >= State->MaxIds)
+    {
+        ++State->InvalidIds;
+        return;
+    }
+
+    Stats = &State->Stats[Marker->Id];
+
+    if (!Marker->IsExit)
+    {
+        if (Stats->EntryCount != 0)
+        {
+            Period = (double)(int64_t)(Marker->TimeNs - Stats->LastEntryNs) / 1e9;
+            if (Stats->PeriodCount == 0 || Period < Stats->PeriodMin)
+            {
+                Stats->PeriodMin = Period;
+            }
+            if (Stats->PeriodCount == 0 || Period > Stats->PeriodMax)
+            {
+                Stats->PeriodMax = Period;
+            }
+
+            ++Stats->PeriodCount;
+            Delta = Period - Stats->PeriodMean;
+            Stats->PeriodMean += Delta / Stats->PeriodCount;
+            Stats->PeriodM2 += Delta * (Period - Stats->PeriodMean);
+        }
+
+        ++Stats->EntryCount;
+        Stats->LastEntryNs   = Marker->TimeNs;
+        Stats->InProgress    = 1;
+    }
+    else
+    {
+        ++Stats->ExitCount;
+
+        /* The log may start in the middle of a measured section */
+        if (!Stats->InProgress)
+        {
+            ++Stats->UnmatchedExits;
+            return;
+        }
+
+        Delta             = (double)(int64_t)(Marker->TimeNs - Stats->LastEntryNs) / 1e9;
+        Stats->InProgress = 0;
+
+        if (Stats->DurationCount == 0 || Delta < Stats->DurationMin)
+        {
+            Stats->DurationMin = Delta;
+        }
+        if (Stats->DurationCount == 0 || Delta > Stats->DurationMax)
+        {
+            Stats->DurationMax = Delta;
+        }
+
+        ++Stats->DurationCount;
+        Stats->DurationSum += Delta;
+        ++Stats->Histogram[PerfLog_HistogramBucket(Delta)];
+    }
+}
+
+/*
+ * Writes the metadata event that names the trace process of a processor
+ */
+static void PerfLog_WriteTraceProcess(FILE *TraceFp, const PerfLog_State_t *State, int IsFirst)
+{
+    fprintf(TraceFp,
+            "%s\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%lu,\"args\":{\"name\":\"CPU %lu\"}}",
+            IsFirst ? "" : ",",
+            (unsigned long)State->ProcessorId,
+            (unsigned long)State->ProcessorId);
+}
+
+/*
+ * Writes one marker as a Chrome trace "B"egin or "E"nd event, relative to the start of the merged timeline
+ */
+static void PerfLog_WriteTraceEvent(FILE *TraceFp, const PerfLog_State_t *State, const PerfLog_Marker_t *Marker,
+                                    uint64_t OriginNs)
+{
+    fprintf(TraceFp,
+            ",\n{\"name\":\"PerfID %lu\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%lu,\"tid\":%lu}",
+            (unsigned long)Marker->Id,
+            Marker->IsExit ? 'E' : 'B',
+            (double)(int64_t)(Marker->TimeNs - OriginNs) / 1e3,
+            (unsigned long)State->ProcessorId,
+            (unsigned long)Marker->Id);
+}
+
+/*
+ * Advances to the next marker of a file, returns -1 on a read error
+ */
+static int PerfLog_Advance(PerfLog_State_t *State)
+{
+    int Status = PerfLog_ReadMarker(State, &State->Next);
+
+    State->HaveNext = (Status > 0);
+
+    return (Status < 0) ? -1 : 0;
+}
+
+static void PerfLog_PrintHistogram(const PerfLog_IdStats_t *Stats)
+{
+    uint32_t Bucket;
+    uint32_t Peak = 0;
+    uint32_t Width;
+
+    for (Bucket = 0; Bucket < PERFLOG_HISTOGRAM_BUCKETS; ++Bucket)
+    {
+        if (Stats->Histogram[Bucket] > Peak)
+        {
+            Peak = Stats->Histogram[Bucket];
+        }
+    }
+
+    for (Bucket = 0; Bucket < PERFLOG_HISTOGRAM_BUCKETS; ++Bucket)
+    {
+        if (Stats->Histogram[Bucket] == 0)
+        {
+            continue;
+        }
+
+        if (Bucket == 0)
+        {
+            printf("    %10s < %-10lu us %10lu ", "", 1UL, (unsigned long)Stats->Histogram[Bucket]);
+        }
+        else
+        {
+            printf("    %10lu - %-10lu us %10lu ",
+                   1UL << (Bucket - 1),
+                   1UL << Bucket,
+                   (unsigned long)Stats->Histogram[Bucket]);
+        }
+
+        for (Width = (40 * Stats->Histogram[Bucket] + Peak - 1) / Peak; Width > 0; --Width)
+        {
+            putchar('#');
+        }
+        putchar('\n');
+    }
+}
+
+static void PerfLog_PrintStats(const PerfLog_State_t *State, int ShowHistograms)
+{
+    const PerfLog_IdStats_t *Stats;
+    uint32_t                 Id;
+    double                   Jitter;
+
+    printf("Performance log %s: CPU %lu, %lu of %lu entries, %lu ticks/sec, trigger count %lu\n",
+           State->FileName,
+           (unsigned long)State->ProcessorId,
+           (unsigned long)State->EntriesRead,
+           (unsigned long)State->Meta.DataCount,
+           (unsigned long)State->Meta.TimerTicksPerSecond,
+           (unsigned long)State->Meta.TriggerCount);
+
+    printf("%5s %8s | %12s %12s %12s | %12s %12s %12s\n",
+           "ID",
+           "Count",
+           "MinDur(us)",
+           "MeanDur(us)",
+           "MaxDur(us)",
+           "MinPer(us)",
+           "MeanPer(us)",
+           "Jitter(us)");
+
+    for (Id = 0; Id < State->MaxIds; ++Id)
+    {
+        Stats = &State->Stats[Id];
+        if (Stats->EntryCount == 0 && Stats->ExitCount == 0)
+        {
+            continue;
+        }
+
+        printf("%5lu %8lu |", (unsigned long)Id, (unsigned long)Stats->EntryCount);
+
+        if (Stats->DurationCount != 0)
+        {
+            printf(" %12.1f %12.1f %12.1f |",
+                   Stats->DurationMin * 1e6,
+                   Stats->DurationSum * 1e6 / Stats->DurationCount,
+                   Stats->DurationMax * 1e6);
+        }
+        else
+        {
+            printf(" %12s %12s %12s |", "-", "-", "-");
+        }
+
+        /* Jitter is reported as the standard deviation of the period */
+        if (Stats->PeriodCount != 0)
+        {
+            Jitter = sqrt(Stats->PeriodM2 / Stats->PeriodCount);
+            printf(" %12.1f %12.1f %12.1f", Stats->PeriodMin * 1e6, Stats->PeriodMean * 1e6, Jitter * 1e6);
+        }
+        else
+        {
+            printf(" %12s %12s %12s", "-", "-", "-");
+        }
+
+        if (Stats->UnmatchedExits != 0)
+        {
+            printf("  (%lu unmatched exits)", (unsigned long)Stats->UnmatchedExits);
+        }
+        putchar('\n');
+
+        if (ShowHistograms && Stats->DurationCount != 0)
+        {
+            PerfLog_PrintHistogram(Stats);
+        }
+    }
+
+    if (State->InvalidIds != 0)
+    {
+        printf("%lu markers had an ID outside of the log ID range\n", (unsigned long)State->InvalidIds);
+    }
+}
+
+static void PerfLog_Usage(const char *Prog)
+{
+    fprintf(stderr, "Usage: %s [-H] [-t <trace json file>] <perf log file> [<perf log file> ...]\n", Prog);
+    fprintf(stderr, "  -H   also print the duration histogram for each ID\n");
+    fprintf(stderr, "  -t   export the markers of all files, merged by time, in Chrome trace event (Perfetto) JSON\n");
+}
+
+int main(int argc, char *argv[])
+{
+    PerfLog_State_t *States;
+    PerfLog_State_t *Earliest;
+    const char      *TraceFileName  = NULL;
+    FILE            *TraceFp        = NULL;
+    uint64_t         OriginNs       = 0;
+    int              HaveOrigin     = 0;
+    int              ShowHistograms = 0;
+    int              NumFiles       = 0;
+    int              Status         = 0;
+    int              i;
+
+    States = calloc(argc, sizeof(PerfLog_State_t));
+    if (States == NULL)
+    {
+        fprintf(stderr, "Error: out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    for (i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-H") == 0)
+        {
+            ShowHistograms = 1;
+        }
+        else if (strcmp(argv[i], "-t") == 0 && (i + 1) < argc)
+        {
+            TraceFileName = argv[++i];
+        }
+        else if (argv[i][0] != '-')
+        {
+            States[NumFiles].FileName = argv[i];
+            ++NumFiles;
+        }
+        else
+        {
+            NumFiles = 0;
+            break;
+        }
+    }
+
+    if (NumFiles == 0)
+    {
+        PerfLog_Usage(argv[0]);
+        free(States);
+        return EXIT_FAILURE;
+    }
+
+    for (i = 0; i < NumFiles && Status == 0; ++i)
+    {
+        States[i].fp = fopen(States[i].FileName, "rb");
+        if (States[i].fp == NULL)
+        {
+            perror(States[i].FileName);
+            Status = -1;
+        }
+        else if (PerfLog_ReadHeaders(&States[i]) != 0)
+        {
+            fprintf(stderr, "Error: cannot reduce %s\n", States[i].FileName);
+            Status = -1;
+        }
+    }
+
+    if (Status == 0 && TraceFileName != NULL)
+    {
+        TraceFp = fopen(TraceFileName, "w");
+        if (TraceFp == NULL)
+        {
+            perror(TraceFileName);
+            Status = -1;
+        }
+        else
+        {
+            fprintf(TraceFp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+            for (i = 0; i < NumFiles; ++i)
+            {
+                PerfLog_WriteTraceProcess(TraceFp, &States[i], i == 0);
+            }
+        }
+    }
+
+    if (Status == 0)
+    {
+        for (i = 0; i < NumFiles; ++i)
+        {
+            if (PerfLog_Advance(&States[i]) != 0)
+            {
+                Status = -1;
+            }
+        }
+
+        /*
+         * Each dump is already in time order, so the merge repeatedly takes
+         * the earliest pending marker of all files.  The first one taken is
+         * the start of the merged timeline.
+         */
+        while (1)
+        {
+            Earliest = NULL;
+            for (i = 0; i < NumFiles; ++i)
+            {
+                if (States[i].HaveNext && (Earliest == NULL || States[i].Next.TimeNs < Earliest->Next.TimeNs))
+                {
+                    Earliest = &States[i];
+                }
+            }
+
+            if (Earliest == NULL)
+            {
+                break;
+            }
+
+            if (!HaveOrigin)
+            {
+                OriginNs   = Earliest->Next.TimeNs;
+                HaveOrigin = 1;
+            }
+
+            PerfLog_Accumulate(Earliest, &Earliest->Next);
+
+            if (TraceFp != NULL && Earliest->Next.Id < Earliest->MaxIds)
+            {
+                PerfLog_WriteTraceEvent(TraceFp, Earliest, &Earliest->Next, OriginNs);
+            }
+
+            if (PerfLog_Advance(Earliest) != 0)
+            {
+                Status = -1;
+            }
+        }
+
+        /* Whatever was read from a truncated file is still reduced, but the exit status reports the error */
+        for (i = 0; i < NumFiles; ++i)
+        {
+            PerfLog_PrintStats(&States[i], ShowHistograms);
+        }
+    }
+
+    if (TraceFp != NULL)
+    {
+        fprintf(TraceFp, "\n]}\n");
+        if (fclose(TraceFp) != 0)
+        {
+            perror(TraceFileName);
+            Status = -1;
+        }
+    }
+
+    for (i = 0; i < NumFiles; ++i)
+    {
+        if (States[i].fp != NULL)
+        {
+            fclose(States[i].fp);
+        }
+        free(States[i].Stats);
+    }
+    free(States);
+
+    return (Status == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,667 @@
+/************************************************************************
+ * NASA Docket No. GSC-18,719-1, and identified as “core Flight System: Bootes”
+ *
+ * Copyright (c) 2020 United States Government as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ************************************************************************/
+
+/**
+ * @file
+ *
+ * Host tool to generate and simulate SCH_LAB schedule tables
+ *
+ * SCH_LAB sends each table entry every "PacketRate" ticks, counting from
+ * startup, so the entries whose rates share a common factor are all sent on
+ * the same ticks.  This tool reads a schedule specification listing the
+ * desired period of each message, the CPU cost of servicing it, and how far
+ * the period may be adjusted.  It then selects the packet rate of each entry
+ * within that tolerance so that entries coincide as little as possible beyond
+ * chance, and emits the matching entries for the SCH_LAB schedule table.
+ *
+ * Since every entry is sent at tick 0, all of them coincide again after the
+ * LCM of all rates, so the peak load of a schedule is always the sum of all
+ * costs and only how often high loads occur can be improved.  Rates are
+ * therefore scored from the rate LCMs of each pair and triple of entries,
+ * rather than from a simulated window, and kept close to the requested ones.
+ *
+ * The specification has one message per line, '#' starts a comment:
+ *
+ *     <MID name>[:<command code>]  <period>  [<cost>  [<tolerance %>]]
+ *
+ * The period is in seconds, or in Hz if suffixed with "Hz".  The cost is in
+ * arbitrary units (e.g. microseconds) and defaults to 1, so that without
+ * measured costs the load is the number of messages per tick.  The tolerance
+ * defaults to the value of the -t option.
+ *
+ * Both the schedule as specified (periods rounded to ticks) and the generated
+ * schedule are scored and simulated, so a specification listing the periods
+ * of the existing table shows the load of that table next to the generated
+ * one.  The simulated peak covers the simulated ticks only (-n option).
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define SCHEDGEN_MAX_ENTRIES 128
+#define SCHEDGEN_MAX_NAME    64
+#define SCHEDGEN_MAX_PASSES  50
+
+typedef struct
+{
+    char     Name[SCHEDGEN_MAX_NAME];
+    char     FcnCode[SCHEDGEN_MAX_NAME];
+    double   Cost;
+    unsigned NominalRate; /* desired period, in ticks */
+    unsigned MinRate;
+    unsigned MaxRate;
+    unsigned Rate; /* selected period, in ticks */
+} SchedGen_Entry_t;
+
+typedef struct
+{
+    double   Peak;
+    unsigned PeakTicks;
+    double   Total;
+} SchedGen_Score_t;
+
+typedef struct
+{
+    unsigned         TickRate;
+    unsigned         Horizon;
+    double           DefaultTolerance;
+    unsigned         NumEntries;
+    SchedGen_Entry_t Entries[SCHEDGEN_MAX_ENTRIES];
+    double          *Load; /* load for ticks 1 through Horizon */
+} SchedGen_State_t;
+
+/*
+ * Converts a period string, in seconds or with an "Hz" suffix, to seconds
+ */
+static int SchedGen_ParsePeriod(const char *Str, double *Seconds)
+{
+    char  *End;
+    double Val = strtod(Str, &End);
+
+    if (End == Str || Val <= 0.0)
+    {
+        return -1;
+    }
+
+    if (strcmp(End, "Hz") == 0 || strcmp(End, "hz") == 0)
+    {
+        Val = 1.0 / Val;
+    }
+    else if (strcmp(End, "ms") == 0)
+    {
+        Val /= 1000.0;
+    }
+    else if (*End != 0 && strcmp(End, "s") != 0)
+    {
+        return -1;
+    }
+
+    *Seconds = Val;
+    return 0;
+}
+
+static int SchedGen_ReadSpec(SchedGen_State_t *State, const char *FileName)
+{
+    FILE             *fp;
+    char              Line[256];
+    char              Name[2 * SCHEDGEN_MAX_NAME];
+    char              Period[32];
+    char             *Ptr;
+    double            Seconds;
+    double            Cost;
+    double            Tolerance;
+    int               Fields;
+    unsigned          LineNum = 0;
+    SchedGen_Entry_t *Entry;
+
+    fp = fopen(FileName, "r");
+    if (fp == NULL)
+    {
+        perror(FileName);
+        return -1;
+    }
+
+    while (fgets(Line, sizeof(Line), fp) != NULL)
+    {
+        ++LineNum;
+
+        Ptr = strchr(Line, '#');
+        if (Ptr != NULL)
+        {
+            *Ptr = 0;
+        }
+
+        Cost      = 1.0;
+        Tolerance = State->DefaultTolerance;
+        Fields    = sscanf(Line, "%127s %31s %lf %lf", Name, Period, &Cost, &Tolerance);
+        if (Fields <= 0)
+        {
+            continue;
+        }
+
+        if (Fields < 2 || SchedGen_ParsePeriod(Period, &Seconds) != 0 || Cost < 0.0 || Tolerance < 0.0)
+        {
+            fprintf(stderr, "%s:%u: invalid schedule entry\n", FileName, LineNum);
+            fclose(fp);
+            return -1;
+        }
+
+        if (State->NumEntries >= SCHEDGEN_MAX_ENTRIES)
+        {
+            fprintf(stderr, "%s:%u: too many entries (max %d)\n", FileName, LineNum, SCHEDGEN_MAX_ENTRIES);
+            fclose(fp);
+            return -1;
+        }
+
+        Entry = &State->Entries[State->NumEntries];
+        memset(Entry, 0, sizeof(*Entry));
+
+        /* An optional command code follows the MID name */
+        Ptr = strchr(Name, ':');
+        if (Ptr != NULL)
+        {
+            *Ptr = 0;
+            ++Ptr;
+        }
+        else
+        {
+            Ptr = Name + strlen(Name);
+        }
+
+        if (strlen(Name) >= sizeof(Entry->Name) || strlen(Ptr) >= sizeof(Entry->FcnCode))
+        {
+            fprintf(stderr,
+                    "%s:%u: MID name or command code too long (max %d characters)\n",
+                    FileName,
+                    LineNum,
+                    SCHEDGEN_MAX_NAME - 1);
+            fclose(fp);
+            return -1;
+        }
+
+        strcpy(Entry->Name, Name);
+        strcpy(Entry->FcnCode, (*Ptr != 0) ? Ptr : "0");
+
+        Entry->Cost        = Cost;
+        Entry->NominalRate = (unsigned)floor(Seconds * State->TickRate + 0.5);
+        Entry->MinRate     = (unsigned)ceil(Seconds * (1.0 - Tolerance / 100.0) * State->TickRate - 1e-9);
+        Entry->MaxRate     = (unsigned)floor(Seconds * (1.0 + Tolerance / 100.0) * State->TickRate + 1e-9);
+
+        /* SCH_LAB cannot send more often than once per tick */
+        if (Entry->NominalRate < 1)
+        {
+            Entry->NominalRate = 1;
+        }
+        if (Entry->MinRate < 1 || Tolerance >= 100.0)
+        {
+            Entry->MinRate = 1;
+        }
+        if (Entry->MinRate > Entry->NominalRate)
+        {
+            Entry->MinRate = Entry->NominalRate;
+        }
+        if (Entry->MaxRate < Entry->NominalRate)
+        {
+            Entry->MaxRate = Entry->NominalRate;
+        }
+
+        Entry->Rate = Entry->NominalRate;
+        ++State->NumEntries;
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+/*
+ * Adds the load of an entry sent every Rate ticks
+ */
+static void SchedGen_ApplyLoad(SchedGen_State_t *State, unsigned Rate, double Cost)
+{
+    unsigned Tick;
+
+    for (Tick = Rate; Tick <= State->Horizon; Tick += Rate)
+    {
+        State->Load[Tick - 1] += Cost;
+    }
+}
+
+static void SchedGen_ComputeLoad(SchedGen_State_t *State, int UseNominal)
+{
+    unsigned i;
+
+    memset(State->Load, 0, State->Horizon * sizeof(double));
+    for (i = 0; i < State->NumEntries; ++i)
+    {
+        SchedGen_ApplyLoad(State,
+                           UseNominal ? State->Entries[i].NominalRate : State->Entries[i].Rate,
+                           State->Entries[i].Cost);
+    }
+}
+
+static void SchedGen_Score(const SchedGen_State_t *State, SchedGen_Score_t *Score)
+{
+    unsigned i;
+    double   Load;
+
+    memset(Score, 0, sizeof(*Score));
+    for (i = 0; i < State->Horizon; ++i)
+    {
+        Load = State->Load[i];
+        if (Load > Score->Peak + 1e-9)
+        {
+            Score->Peak      = Load;
+            Score->PeakTicks = 1;
+        }
+        else if (Load > Score->Peak - 1e-9)
+        {
+            ++Score->PeakTicks;
+        }
+        Score->Total += Load;
+    }
+}
+
+static uint64_t SchedGen_Gcd(uint64_t A, uint64_t B)
+{
+    uint64_t Tmp;
+
+    while (B != 0)
+    {
+        Tmp = A % B;
+        A   = B;
+        B   = Tmp;
+    }
+
+    return A;
+}
+
+static uint64_t SchedGen_Lcm(uint64_t A, uint64_t B)
+{
+    return (A / SchedGen_Gcd(A, B)) * B;
+}
+
+/*
+ * Extra load expected on each tick an entry with the given rate is sent,
+ * beyond chance, from another entry or pair of entries (sent together every
+ * Other ticks) whose rate shares a factor with it.  An unrelated entry is
+ * sent on 1/Other of those ticks, a related one on gcd(Rate, Other) times
+ * as many.  This is per send, so it does not change just because the entry
+ * is sent less often.
+ */
+static double SchedGen_Excess(unsigned Rate, uint64_t Other, double Cost)
+{
+    return Cost * (double)(SchedGen_Gcd(Rate, Other) - 1) / (double)Other;
+}
+
+static unsigned SchedGen_GetRate(const SchedGen_Entry_t *Entry, int UseNominal)
+{
+    return UseNominal ? Entry->NominalRate : Entry->Rate;
+}
+
+/*
+ * Collision score of entry Index if it were sent every Rate ticks: the extra
+ * load it meets on its sends from every other entry and every pair of other
+ * entries whose rates share a factor with it.  This is computed from the rate
+ * LCMs rather than a simulated window.
+ */
+static double SchedGen_EntryCollisions(const SchedGen_State_t *State, unsigned Index, unsigned Rate, int UseNominal)
+{
+    const SchedGen_Entry_t *E   = State->Entries;
+    double                  Sum = 0.0;
+    unsigned                j;
+    unsigned                k;
+
+    for (j = 0; j < State->NumEntries; ++j)
+    {
+        if (j == Index)
+        {
+            continue;
+        }
+
+        Sum += SchedGen_Excess(Rate, SchedGen_GetRate(&E[j], UseNominal), E[j].Cost);
+
+        for (k = j + 1; k < State->NumEntries; ++k)
+        {
+            if (k == Index)
+            {
+                continue;
+            }
+
+            Sum += SchedGen_Excess(
+                Rate,
+                SchedGen_Lcm(SchedGen_GetRate(&E[j], UseNominal), SchedGen_GetRate(&E[k], UseNominal)),
+                E[j].Cost + E[k].Cost);
+        }
+    }
+
+    return Sum;
+}
+
+/*
+ * Collision score of the whole schedule, the sum of that of each entry weighted by its cost
+ */
+static double SchedGen_Collisions(const SchedGen_State_t *State, int UseNominal)
+{
+    double   Sum = 0.0;
+    unsigned i;
+
+    for (i = 0; i < State->NumEntries; ++i)
+    {
+        Sum += State->Entries[i].Cost
+               * SchedGen_EntryCollisions(State, i, SchedGen_GetRate(&State->Entries[i], UseNominal), UseNominal);
+    }
+
+    return Sum;
+}
+
+/*
+ * Gets the number of ticks after which every entry is sent on the same tick
+ * again, i.e. the LCM of all rates.  Returns 0 if that does not fit in 64 bits.
+ */
+static uint64_t SchedGen_CommonPeriod(const SchedGen_State_t *State, int UseNominal)
+{
+    uint64_t Lcm = 1;
+    uint64_t Factor;
+    unsigned Rate;
+    unsigned i;
+
+    for (i = 0; i < State->NumEntries; ++i)
+    {
+        Rate   = SchedGen_GetRate(&State->Entries[i], UseNominal);
+        Factor = Rate / SchedGen_Gcd(Lcm, Rate);
+        if (Lcm > UINT64_MAX / Factor)
+        {
+            return 0;
+        }
+        Lcm *= Factor;
+    }
+
+    return Lcm;
+}
+
+static unsigned SchedGen_Distance(unsigned A, unsigned B)
+{
+    return (A > B) ? (A - B) : (B - A);
+}
+
+/*
+ * Repeatedly re-selects the rate of one entry at a time, with all other
+ * entries held fixed, until no single change lowers the score any further.
+ *
+ * The score of a rate is the collision score of the entry plus the mean load
+ * times its relative distance from the requested rate, so moving an entry by
+ * 10% of its period must save at least 10% of the mean load in collisions.
+ * Entries are visited starting from the middle of the requested rates, as
+ * each takes the nearest free rate and pushes later entries away from it:
+ * this way they are pushed to both sides, not all towards longer periods.
+ */
+static void SchedGen_Optimize(SchedGen_State_t *State)
+{
+    SchedGen_Entry_t *Entry;
+    unsigned          Order[SCHEDGEN_MAX_ENTRIES];
+    unsigned          NumOrder = 0;
+    double            MeanLoad = 0.0;
+    double            Center   = 0.0;
+    double            Score;
+    double            BestScore;
+    unsigned          BestRate;
+    unsigned          Rate;
+    unsigned          Pass;
+    unsigned          Tmp;
+    unsigned          i;
+    unsigned          j;
+    int               Changed = 1;
+
+    for (i = 0; i < State->NumEntries; ++i)
+    {
+        Entry = &State->Entries[i];
+        MeanLoad += Entry->Cost / Entry->NominalRate;
+        if (Entry->MinRate != Entry->MaxRate)
+        {
+            Center += Entry->NominalRate;
+            Order[NumOrder++] = i;
+        }
+    }
+
+    if (NumOrder == 0)
+    {
+        return;
+    }
+    Center /= NumOrder;
+
+    for (i = 1; i < NumOrder; ++i)
+    {
+        for (j = i; j > 0
+                    && fabs(State->Entries[Order[j]].NominalRate - Center)
+                           < fabs(State->Entries[Order[j - 1]].NominalRate - Center);
+             --j)
+        {
+            Tmp          = Order[j];
+            Order[j]     = Order[j - 1];
+            Order[j - 1] = Tmp;
+        }
+    }
+
+    for (Pass = 0; Changed && Pass < SCHEDGEN_MAX_PASSES; ++Pass)
+    {
+        Changed = 0;
+        for (i = 0; i < NumOrder; ++i)
+        {
+            Entry = &State->Entries[Order[i]];
+
+            BestRate  = Entry->Rate;
+            BestScore = SchedGen_EntryCollisions(State, Order[i], BestRate, 0)
+                        + MeanLoad * SchedGen_Distance(BestRate, Entry->NominalRate) / Entry->NominalRate;
+
+            for (Rate = Entry->MinRate; Rate <= Entry->MaxRate; ++Rate)
+            {
+                Score = SchedGen_EntryCollisions(State, Order[i], Rate, 0)
+                        + MeanLoad * SchedGen_Distance(Rate, Entry->NominalRate) / Entry->NominalRate;
+                if (Score < BestScore - 1e-9)
+                {
+                    BestScore = Score;
+                    BestRate  = Rate;
+                }
+            }
+
+            if (BestRate != Entry->Rate)
+            {
+                Entry->Rate = BestRate;
+                Changed     = 1;
+            }
+        }
+    }
+}
+
+/*
+ * Prints the collision score, when all entries next coincide, and the load
+ * seen over the simulated ticks.  The simulated peak only covers that window:
+ * entries with related rates keep coinciding on the multiples of their LCM
+ * beyond it, and every entry is sent on the common period tick.
+ */
+static void SchedGen_PrintSummary(const char *Title, SchedGen_State_t *State, int UseNominal)
+{
+    SchedGen_Score_t Score;
+    double           Total = 0.0;
+    uint64_t         Common;
+    unsigned         i;
+
+    SchedGen_ComputeLoad(State, UseNominal);
+    SchedGen_Score(State, &Score);
+    Common = SchedGen_CommonPeriod(State, UseNominal);
+    for (i = 0; i < State->NumEntries; ++i)
+    {
+        Total += State->Entries[i].Cost;
+    }
+
+    printf("/* %-10s collision score %12.1f, ", Title, SchedGen_Collisions(State, UseNominal));
+    if (Common != 0)
+    {
+        printf("load %.1f every %llu ticks (%.3g seconds) */\n",
+               Total,
+               (unsigned long long)Common,
+               (double)Common / State->TickRate);
+    }
+    else
+    {
+        printf("load %.1f less than once per 2^64 ticks */\n", Total);
+    }
+    printf("/* %-10s ticks 1 to %u only (%.0f seconds): peak load %.1f on %u ticks, mean load %.2f */\n",
+           "",
+           State->Horizon,
+           (double)State->Horizon / State->TickRate,
+           Score.Peak,
+           Score.PeakTicks,
+           Score.Total / State->Horizon);
+}
+
+static void SchedGen_PrintTable(const SchedGen_State_t *State)
+{
+    const SchedGen_Entry_t *Entry;
+    char                    Buffer[2 * SCHEDGEN_MAX_NAME + 32];
+    int                     Digits = (State->TickRate > 100) ? 3 : (State->TickRate > 10) ? 2 : 1;
+    unsigned                i;
+
+    printf("    .TickRate = %u,\n", State->TickRate);
+    printf("    .Config   = {\n");
+    for (i = 0; i < State->NumEntries; ++i)
+    {
+        Entry = &State->Entries[i];
+        snprintf(Buffer, sizeof(Buffer), "{CFE_SB_MSGID_WRAP_VALUE(%s),", Entry->Name);
+        printf("        %-56s %4u, %s}, /* every %.*f seconds */\n",
+               Buffer,
+               Entry->Rate,
+               Entry->FcnCode,
+               Digits,
+               (double)Entry->Rate / State->TickRate);
+    }
+    printf("    }\n");
+}
+
+static void SchedGen_Usage(const char *Prog)
+{
+    fprintf(stderr, "Usage: %s [-r <ticks/sec>] [-n <ticks>] [-t <tolerance %%>] [-s] [-l] <spec file>\n", Prog);
+    fprintf(stderr, "  -r   SCH_LAB tick rate (default 10)\n");
+    fprintf(stderr, "  -n   number of ticks to simulate for the peak load (default 600 seconds worth)\n");
+    fprintf(stderr, "  -t   default period tolerance for entries that do not specify one (default 0)\n");
+    fprintf(stderr, "  -s   simulate the schedule as specified only, do not generate a new one\n");
+    fprintf(stderr, "  -l   print the load of every simulated tick\n");
+}
+
+int main(int argc, char *argv[])
+{
+    static SchedGen_State_t State;
+    double                 *SpecLoad;
+    const char             *FileName     = NULL;
+    int                     SimulateOnly = 0;
+    int                     ListTicks    = 0;
+    unsigned                Tick;
+    int                     i;
+
+    State.TickRate = 10;
+
+    for (i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-r") == 0 && (i + 1) < argc)
+        {
+            State.TickRate = (unsigned)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "-n") == 0 && (i + 1) < argc)
+        {
+            State.Horizon = (unsigned)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "-t") == 0 && (i + 1) < argc)
+        {
+            State.DefaultTolerance = strtod(argv[++i], NULL);
+        }
+        else if (strcmp(argv[i], "-s") == 0)
+        {
+            SimulateOnly = 1;
+        }
+        else if (strcmp(argv[i], "-l") == 0)
+        {
+            ListTicks = 1;
+        }
+        else if (argv[i][0] != '-' && FileName == NULL)
+        {
+            FileName = argv[i];
+        }
+        else
+        {
+            SchedGen_Usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (FileName == NULL || State.TickRate == 0 || State.DefaultTolerance < 0.0)
+    {
+        SchedGen_Usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (State.Horizon == 0)
+    {
+        State.Horizon = 600 * State.TickRate;
+    }
+
+    if (SchedGen_ReadSpec(&State, FileName) != 0)
+    {
+        return EXIT_FAILURE;
+    }
+
+    State.Load = calloc(State.Horizon, sizeof(double));
+    SpecLoad   = calloc(State.Horizon, sizeof(double));
+    if (State.Load == NULL || SpecLoad == NULL)
+    {
+        fprintf(stderr, "Error: out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    SchedGen_PrintSummary("Specified:", &State, 1);
+    memcpy(SpecLoad, State.Load, State.Horizon * sizeof(double));
+
+    if (!SimulateOnly)
+    {
+        SchedGen_Optimize(&State);
+        SchedGen_PrintSummary("Generated:", &State, 0);
+        SchedGen_PrintTable(&State);
+    }
+
+    if (ListTicks)
+    {
+        printf("/*  Tick  Specified%s\n", SimulateOnly ? "" : "  Generated");
+        for (Tick = 0; Tick < State.Horizon; ++Tick)
+        {
+            printf("   %6u %10.1f", Tick + 1, SpecLoad[Tick]);
+            if (!SimulateOnly)
+            {
+                printf(" %10.1f", State.Load[Tick]);
+            }
+            putchar('\n');
+        }
+        printf("*/\n");
+    }
+
+    free(SpecLoad);
+    free(State.Load);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,31 @@
+#
+# Schedule specification matching sample_defs/tables/sch_lab_table.c
+#
+# Format: <MID name>[:<command code>]  <period>  [<cost>  [<tolerance %>]]
+#
+# The periods below are those of the existing table, so "Specified" in the
+# tool output is the load of that table.  The housekeeping requests may be
+# moved by up to 25% to spread the load; the wakeup messages keep their rates.
+# No per-message costs have been measured yet, so each message counts as 1.
+#
+CFE_ES_SEND_HK_MID       4.0s  1  25
+CFE_EVS_SEND_HK_MID      4.2s  1  25
+CFE_TIME_SEND_HK_MID     4.4s  1  25
+CFE_SB_SEND_HK_MID       4.6s  1  25
+CFE_TBL_SEND_HK_MID      4.8s  1  25
+CI_LAB_SEND_HK_MID       5.0s  1  25
+TO_LAB_SEND_HK_MID       5.2s  1  25
+SAMPLE_APP_SEND_HK_MID   5.4s  1  25
+CF_SEND_HK_MID           5.6s  1  25
+CF_WAKE_UP_MID           10Hz  1
+MD_SEND_HK_MID           5.8s  1  25
+HS_SEND_HK_MID           6.0s  1  25
+SC_SEND_HK_MID           6.2s  1  25
+SC_WAKEUP_MID            1Hz   1
+FM_SEND_HK_MID           6.6s  1  25
+DS_SEND_HK_MID           6.8s  1  25
+LC_SEND_HK_MID           7.0s  1  25
+CS_SEND_HK_MID           7.2s  1  25
+CS_BACKGROUND_CYCLE_MID  2Hz   1
+MM_SEND_HK_MID           7.4s  1  25
+HK_SEND_HK_MID           7.6s  1  25